@@ -0,0 +1,245 @@
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#define CJ_IMPLEMENTATION
+#include "cj.h"
+
+typedef struct {
+    const char* name;
+    int age;
+}Person;
+
+static const CJField person_fields[] = {
+    CJ_FIELD(Person, name, CJ_FIELD_STRING),
+    CJ_FIELD(Person, age, CJ_FIELD_INT),
+};
+
+typedef struct Node {
+    struct Node* next;
+    int value;
+}Node;
+
+const void* node_next(const void* node) {
+    return ((const Node*)node)->next;
+}
+
+bool node_value(CJ* cj, const void* node) {
+    return cj_number(cj, ((const Node*)node)->value);
+}
+
+Node* make_nodes(size_t n) {
+    Node* nodes = malloc(sizeof(*nodes) * n);
+    for (size_t i = 0; i < n; ++i) {
+        nodes[i].value = i;
+        nodes[i].next = i + 1 < n? &nodes[i + 1] : NULL;
+    }
+    return nodes;
+}
+
+void write_file(FILE* sink, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(sink, fmt, args);
+    va_end(args);
+}
+
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    CJShared* shared;
+    size_t first;
+    size_t count;
+    bool ok;
+}Worker;
+
+void* worker_run(void* arg) {
+    Worker* worker = arg;
+    CJBuffer buffer = {};
+    CJ* cj = cj_new_sink(&buffer, cj_buffer_write);
+
+    worker->ok = true;
+    for (size_t i = worker->first; i < worker->first + worker->count; ++i) {
+        cj_begin_object(cj);
+        cj_key(cj, "id");
+        cj_number(cj, i);
+        cj_key(cj, "name");
+        cj_string(cj, "worker record");
+        cj_end_object(cj);
+
+        if (!cj_shared_commit(worker->shared, cj, &buffer)) worker->ok = false;
+    }
+    if (!cj_shared_flush(worker->shared, &buffer)) worker->ok = false;
+
+    cj_delete(cj);
+    cj_buffer_free(&buffer);
+    return NULL;
+}
+
+bool bench_shared(const char* path, size_t n, size_t threads) {
+    CJShared shared;
+    if (!cj_shared_open(&shared, path)) return false;
+
+    pthread_t ids[threads];
+    Worker workers[threads];
+    for (size_t i = 0; i < threads; ++i) {
+        workers[i] = (Worker) { .shared = &shared, .first = n / threads * i, .count = n / threads };
+        pthread_create(&ids[i], NULL, worker_run, &workers[i]);
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_join(ids[i], NULL);
+        ok = ok && workers[i].ok;
+    }
+
+    return cj_shared_close(&shared) && ok;
+}
+
+void dump_people(CJ* cj, size_t n) {
+    cj_begin_array(cj);
+    for (size_t i = 0; i < n; ++i) {
+        cj_begin_object(cj);
+        cj_key(cj, "name");
+        cj_string(cj, "Joe Mama");
+        cj_key(cj, "age");
+        cj_number(cj, i % 100);
+        cj_key(cj, "email");
+        cj_string(cj, "joe@example.com");
+        cj_end_object(cj);
+    }
+    cj_end_array(cj);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1? strtoull(argv[1], NULL, 10) : 10*1000*1000;
+    const char* path = argc > 2? argv[2] : "/tmp/cj_bench.json";
+    FILE* sink = fopen("/dev/null", "w");
+    if (sink == NULL) return 1;
+
+    Node* nodes = make_nodes(n);
+
+    CJ* cj = cj_new(sink, write_file);
+    double start = now();
+    bool ok = cj_list_nested(cj, nodes, "value", "next", node_next, node_value);
+    printf("list nested: %zu nodes in %.3fs (%s)\n", n, now() - start, ok? "ok" : cj_get_error(cj));
+    cj_delete(cj);
+
+    cj = cj_new(sink, write_file);
+    start = now();
+    ok = cj_list_array(cj, nodes, node_next, node_value);
+    printf("list array:  %zu nodes in %.3fs (%s)\n", n, now() - start, ok? "ok" : cj_get_error(cj));
+    cj_delete(cj);
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return 1;
+    cj = cj_new(file, write_file);
+    start = now();
+    ok = cj_list_array(cj, nodes, node_next, node_value);
+    ok = fclose(file) == 0 && ok;
+    printf("fprintf to %s: %.3fs (%s)\n", path, now() - start, ok? "ok" : cj_get_error(cj));
+    cj_delete(cj);
+
+    CJMmap out;
+    if (!cj_mmap_open(&out, path, 0)) return 1;
+    cj = cj_new_sink(&out, cj_mmap_write);
+    start = now();
+    ok = cj_list_array(cj, nodes, node_next, node_value);
+    ok = cj_mmap_close(&out) && ok;
+    printf("mmap to %s:    %.3fs (%s)\n", path, now() - start, ok? "ok" : cj_get_error(cj));
+    cj_delete(cj);
+
+    CJBuffer doc = {};
+    cj = cj_new_sink(&doc, cj_buffer_write);
+    cj_begin_object(cj);
+    cj_key(cj, "nodes");
+    cj_list_nested(cj, nodes, "value", "next", node_next, node_value);
+    cj_key(cj, "id");
+    cj_number(cj, 42);
+    cj_end_object(cj);
+    cj_delete(cj);
+
+    CJSlice id;
+    start = now();
+    ok = cj_find(doc.count, doc.items, "/id", &id);
+    printf("find /id after %zu bytes: %.3fs (%s)\n", doc.count, now() - start, ok? "ok" : "not found");
+    cj_buffer_free(&doc);
+
+    CJBuffer people = {};
+    cj = cj_new_sink(&people, cj_buffer_write);
+    start = now();
+    dump_people(cj, n);
+    printf("people into a growing buffer: %.3fs\n", now() - start);
+    cj_delete(cj);
+
+    start = now();
+    cj = cj_new_counter();
+    dump_people(cj, n);
+    size_t size = cj_size(cj);
+    cj_delete(cj);
+    char* exact = malloc(size);
+    cj = cj_new_fixed(exact, size);
+    dump_people(cj, n);
+    cj_delete(cj);
+    printf("people counted, then into an exact buffer: %.3fs (%s)\n", now() - start,
+           size == people.count && memcmp(exact, people.items, size) == 0? "ok" : "mismatch");
+    free(exact);
+
+    start = now();
+    cj = cj_new_counter();
+    cj_canonical(cj, true);
+    cj_hash_begin(cj, 0);
+    dump_people(cj, n);
+    printf("people hashed without output: %.3fs (%016llx)\n", now() - start, (unsigned long long)cj_hash_digest(cj));
+    cj_delete(cj);
+
+    CJStruct* person = cj_struct_new(sizeof(Person), 2, person_fields);
+    void* loaded = NULL;
+    size_t loaded_count = 0;
+    start = now();
+    ok = cj_parse_structs(person, people.count, people.items, &loaded, &loaded_count) == people.count;
+    printf("load %zu people: %.3fs (%s)\n", loaded_count, now() - start, ok? "ok" : "failed");
+    for (size_t i = 0; i < loaded_count; ++i) {
+        free((char*)((Person*)loaded)[i].name);
+    }
+    free(loaded);
+    cj_struct_delete(person);
+
+    char* copy = malloc(people.count);
+    start = now();
+    memcpy(copy, people.items, people.count);
+    printf("copy %zu bytes: %.3fs (%s)\n", people.count, now() - start,
+           memcmp(copy, people.items, people.count) == 0? "ok" : "mismatch");
+    free(copy);
+
+    CJRule rules[] = {
+        { .path = "/*/email", .action = CJ_RULE_DROP },
+    };
+    CJFilter* filter = cj_filter_new(1, rules);
+    CJBuffer filtered = {};
+    cj = cj_new_sink(&filtered, cj_buffer_write);
+    start = now();
+    ok = cj_filter_run(filter, cj, people.count, people.items);
+    printf("filter emails out of %zu bytes: %.3fs (%s)\n", people.count, now() - start, ok? "ok" : cj_get_error(cj));
+    cj_delete(cj);
+    cj_buffer_free(&filtered);
+    cj_filter_delete(filter);
+    cj_buffer_free(&people);
+
+    size_t threads = argc > 3? strtoull(argv[3], NULL, 10) : 4;
+    for (size_t t = 1; t <= threads; t *= 2) {
+        start = now();
+        ok = bench_shared(path, n, t);
+        printf("shared, %zu threads: %.3fs (%s)\n", t, now() - start, ok? "ok" : "failed");
+    }
+
+    free(nodes);
+    fclose(sink);
+    return 0;
+}
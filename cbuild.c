@@ -1,13 +1,118 @@
 #define CBUILD_IMPLEMENTATION
 #include "cbuild.h"
 
+#define BUILD_DIR "build"
+// Workload the PGO profile is collected on
+#define PGO_NODES "2000000"
+
+void build_targets(Jobs* jobs, Cmd* cmd, const char* dir, const char** cflags) {
+    jobs_maybe_build_c(jobs, cmd, CC_GCC, path_join(dir, "cj"), STRS("main.c", "cj.h"), cflags);
+    jobs_maybe_build_c(jobs, cmd, CC_GCC, path_join(dir, "bench"), STRS("bench.c", "cj.h"), cflags);
+}
+
+bool build_profile_dir(const char* name, char** dir) {
+    *dir = path_join(BUILD_DIR, name);
+    return create_dir_if_not_exists(BUILD_DIR) && create_dir_if_not_exists(*dir);
+}
+
+bool build_isa_variants(Jobs* jobs, Cmd* cmd) {
+#if defined(__x86_64__)
+    char* dir;
+    if (!build_profile_dir("isa", &dir)) return false;
+
+    const char** release = profile_cflags(PROFILE_RELEASE);
+    // The last -march wins, so these override the release one
+    jobs_maybe_build_c(jobs, cmd, CC_GCC, path_join(dir, "bench-baseline"), STRS("bench.c", "cj.h"), strs_concat(release, STRS("-march=x86-64")));
+    jobs_maybe_build_c(jobs, cmd, CC_GCC, path_join(dir, "bench-avx2"), STRS("bench.c", "cj.h"), strs_concat(release, STRS("-march=x86-64-v3")));
+#else
+    (void) jobs;
+    (void) cmd;
+    fprintf(stderr, "[WARN] ISA variants are only defined for x86_64\n");
+#endif
+    return true;
+}
+
+// Builds an instrumented bench, runs the workload and rebuilds it with the collected profile
+bool build_pgo(Jobs* jobs, Cmd* cmd) {
+    char* dir;
+    if (!build_profile_dir("pgo", &dir)) return false;
+
+    char* bench = path_join(dir, "bench");
+    // gcc names the profile of a source compiled and linked in one step <output>-<source>.gcda.
+    // Stale counters from older sources would be merged into the new ones
+    char* gcda = path_join(dir, "bench-bench.gcda");
+    if (remove(gcda) != 0 && errno != ENOENT) {
+        fprintf(stderr, "[ERROR] could not remove %s: %s\n", gcda, strerror(errno));
+        return false;
+    }
+
+    cmd_push_build_c(cmd, CC_GCC, bench, STRS("bench.c", "cj.h"), profile_cflags(PROFILE_PGO_GENERATE));
+    if (!cmd_run_sync(cmd, true)) return false;
+
+    cmd->count = 0;
+    cmd_push_str(cmd, bench, PGO_NODES, path_join(dir, "bench.json"));
+    if (!cmd_run_sync(cmd, true)) return false;
+
+    cmd->count = 0;
+    cmd_push_build_c(cmd, CC_GCC, bench, STRS("bench.c", "cj.h"), profile_cflags(PROFILE_PGO_USE));
+    return jobs_run(jobs, cmd, true);
+}
+
+// Builds and runs the checks of the number parsers and cj_double
+bool build_test(Cmd* cmd) {
+    cmd->count = 0;
+    cmd_push_build_c(cmd, CC_GCC, "./test_numbers", STRS("test_numbers.c", "cj.h"), profile_cflags(PROFILE_DEBUG));
+    if (!cmd_run_sync(cmd, true)) return false;
+
+    cmd->count = 0;
+    cmd_push_str(cmd, "./test_numbers");
+    return cmd_run_sync(cmd, true);
+}
+
 int main(int argc, char** argv) {
     Cmd cmd = {};
+    Jobs jobs = {};
 
-    const char* cflags[] = STRS_LIT("-Wall", "-Wextra", "-ggdb");
     build_yourself(&cmd, argc, argv);
 
-    if (!cmd_maybe_build_c(&cmd, CC_GCC, "cj", STRS("main.c", "cj.h"), cflags)) return 1;
+    const char* profile = argc > 1? argv[1] : "debug";
+    bool all = strcmp(profile, "all") == 0;
+    bool known = all;
+    char* dir;
+
+    if (all || strcmp(profile, "debug") == 0) {
+        build_targets(&jobs, &cmd, ".", profile_cflags(PROFILE_DEBUG));
+        known = true;
+    }
+    if (all || strcmp(profile, "release") == 0) {
+        if (!build_profile_dir("release", &dir)) return 1;
+        build_targets(&jobs, &cmd, dir, profile_cflags(PROFILE_RELEASE));
+        known = true;
+    }
+    if (all || strcmp(profile, "lto") == 0) {
+        if (!build_profile_dir("lto", &dir)) return 1;
+        build_targets(&jobs, &cmd, dir, profile_cflags(PROFILE_LTO));
+        known = true;
+    }
+    if (all || strcmp(profile, "isa") == 0) {
+        if (!build_isa_variants(&jobs, &cmd)) return 1;
+        known = true;
+    }
+    if (all || strcmp(profile, "pgo") == 0) {
+        if (!build_pgo(&jobs, &cmd)) return 1;
+        known = true;
+    }
+    if (all || strcmp(profile, "test") == 0) {
+        if (!build_test(&cmd)) return 1;
+        known = true;
+    }
+
+    if (!known) {
+        fprintf(stderr, "Usage: %s [debug|release|lto|pgo|isa|test|all]\n", argv[0]);
+        return 1;
+    }
+
+    if (!jobs_wait(&jobs)) return 1;
 
     return 0;
 }
@@ -37,19 +37,45 @@ typedef enum {
     CC_CLANG,
 }CC;
 
+typedef enum {
+    PROFILE_DEBUG,
+    PROFILE_RELEASE,
+    PROFILE_LTO,
+    PROFILE_PGO_GENERATE,
+    PROFILE_PGO_USE,
+}Profile;
+
 typedef int Pid;
 
+typedef struct {
+    Pid* items;
+    size_t count;
+    size_t capacity;
+    // Number of commands allowed to run at once, 0 means the number of CPUs
+    size_t max_jobs;
+    bool failed;
+}Jobs;
+
 // Returns true if path1 was modified after path2
 bool is_path_modified_after(const char* path1, const char* path2);
 
 // Returns the provided path with the specified extension. "." MUST be specified by user
 char* path_with_ext(const char* path, const char* ext);
 
+// Returns dir/name
+char* path_join(const char* dir, const char* name);
+
 // Returns true if the source files were modified after the target file. The srcs array MUST be NULL terminated
 bool need_rebuild(const char* target, const char** srcs);
 #define STRS(...) ((const char*[]) { __VA_ARGS__, NULL })
 #define STRS_LIT(...) { __VA_ARGS__, NULL }
 
+// Returns a new NULL terminated array with the strings of a followed by those of b
+const char** strs_concat(const char** a, const char** b);
+
+// Returns the NULL terminated cflags of a build profile. Profiles other than debug optimize for the host CPU
+const char** profile_cflags(Profile profile);
+
 // Rebuild the build program
 void build_yourself_(Cmd* cmd, const char** cflags, size_t cflags_count, const char* src, int argc, char** argv);
 #define build_yourself(cmd, argc, argv) assert(argc >= 1); build_yourself_(cmd, NULL, 0, __FILE__, argc, argv)
@@ -82,8 +108,19 @@ bool cmd_run_sync(Cmd* cmd, bool log_cmd);
 // Displays a CMD to stdout
 void cmd_display(Cmd* cmd);
 
+// Pushes the command building target from srcs
+void cmd_push_build_c(Cmd* cmd, CC cc, const char* target, const char** srcs, const char** cflags);
 bool cmd_maybe_build_c(Cmd* cmd, CC cc, const char* target, const char** srcs, const char** cflags);
 
+// Returns the number of online CPUs
+size_t cpu_count(void);
+// Runs the cmd once a job slot is free and empties the cmd. Returns false without running it if a job already failed
+bool jobs_run(Jobs* jobs, Cmd* cmd, bool log_cmd);
+// Waits for all running jobs and returns if all of them were successful
+bool jobs_wait(Jobs* jobs);
+// Same as cmd_maybe_build_c, but runs the build as a job
+bool jobs_maybe_build_c(Jobs* jobs, Cmd* cmd, CC cc, const char* target, const char** srcs, const char** cflags);
+
 #define CMD(out, ...) do { \
         const char* args[] = { __VA_ARGS__, NULL }; \
         size_t len = sizeof(args)/sizeof(args[0]); \
@@ -157,6 +194,52 @@ char* path_with_ext(const char* path, const char* ext) {
     }
 }
 
+char* path_join(const char* dir, const char* name) {
+    size_t dir_len = strlen(dir);
+    size_t name_len = strlen(name);
+    char* out = CBUILD_MALLOC(dir_len + name_len + 2);
+    memcpy(out, dir, dir_len);
+    out[dir_len] = '/';
+    memcpy(out + dir_len + 1, name, name_len);
+    out[dir_len + name_len + 1] = 0;
+    return out;
+}
+
+const char** strs_concat(const char** a, const char** b) {
+    size_t a_count = 0, b_count = 0;
+    while (a[a_count] != NULL) a_count++;
+    while (b[b_count] != NULL) b_count++;
+
+    const char** out = CBUILD_MALLOC(sizeof(*out) * (a_count + b_count + 1));
+    memcpy(out, a, sizeof(*out) * a_count);
+    memcpy(out + a_count, b, sizeof(*out) * b_count);
+    out[a_count + b_count] = NULL;
+    return out;
+}
+
+const char** profile_cflags(Profile profile) {
+    static const char* debug[] = STRS_LIT("-Wall", "-Wextra", "-ggdb");
+    static const char* release[] = STRS_LIT("-Wall", "-Wextra", "-O3", "-march=native", "-DNDEBUG");
+    static const char* lto[] = STRS_LIT("-Wall", "-Wextra", "-O3", "-march=native", "-DNDEBUG", "-flto=auto");
+    // Counters are updated atomically so multi-threaded workloads give usable profiles.
+    // Both phases use LTO so they compile the same CFG
+    static const char* pgo_generate[] = STRS_LIT("-Wall", "-Wextra", "-O3", "-march=native", "-DNDEBUG",
+                                                 "-flto=auto", "-fprofile-generate", "-fprofile-update=prefer-atomic");
+    static const char* pgo_use[] = STRS_LIT("-Wall", "-Wextra", "-O3", "-march=native", "-DNDEBUG", "-flto=auto",
+                                            "-fprofile-use", "-fprofile-correction", "-Wmissing-profile");
+
+    switch (profile) {
+        case PROFILE_DEBUG: return debug;
+        case PROFILE_RELEASE: return release;
+        case PROFILE_LTO: return lto;
+        case PROFILE_PGO_GENERATE: return pgo_generate;
+        case PROFILE_PGO_USE: return pgo_use;
+    }
+
+    assert(0 && "unreachable");
+    return NULL;
+}
+
 bool need_rebuild(const char* target, const char** srcs) {
     if (srcs == NULL) return true;
 
@@ -333,36 +416,121 @@ void cmd_display(Cmd* cmd) {
     }
 }
 
+void cmd_push_build_c(Cmd* cmd, CC cc, const char* target, const char** srcs, const char** cflags) {
+    switch (cc) {
+        case CC_GCC:
+            cmd_push_str(cmd, "gcc");
+            break;
+        case CC_CLANG:
+            cmd_push_str(cmd, "clang");
+            break;
+    }
+
+    if (cflags != NULL) {
+        const char* cflag = *cflags;
+        while (cflag != NULL) {
+            cmd_push_str(cmd, cflag);
+            cflag = *(++cflags);
+        }
+    }
+
+    cmd_push_str(cmd, "-o", target);
+
+    if (srcs != NULL) {
+        const char* src = *srcs;
+        while (src != NULL) {
+            cmd_push_str(cmd, src);
+            src = *(++srcs);
+        }
+    }
+}
+
 bool cmd_maybe_build_c(Cmd* cmd, CC cc, const char* target, const char** srcs, const char** cflags) {
     if (need_rebuild(target, srcs)) {
-        switch (cc) {
-            case CC_GCC:
-                cmd_push_str(cmd, "gcc");
-                break;
-            case CC_CLANG:
-                cmd_push_str(cmd, "clang");
-                break;
+        cmd_push_build_c(cmd, cc, target, srcs, cflags);
+        return cmd_run_sync(cmd, true);
+    }
+
+    return true;
+}
+
+size_t cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1? 1 : count;
+}
+
+// Reaps any one job
+static bool jobs_wait_one(Jobs* jobs) {
+    int wstatus = 0;
+    Pid pid = waitpid(-1, &wstatus, 0);
+    if (pid < 0) {
+        if (errno == EINTR) return true;
+        fprintf(stderr, "[ERROR] could not wait on jobs: %s\n", strerror(errno));
+        jobs->count = 0;
+        jobs->failed = true;
+        return false;
+    }
+
+    for (size_t i = 0; i < jobs->count; ++i) {
+        if (jobs->items[i] == pid) {
+            jobs->items[i] = jobs->items[--jobs->count];
+            break;
         }
+    }
 
-        if (cflags != NULL) {
-            const char* cflag = *cflags;
-            while (cflag != NULL) {
-                cmd_push_str(cmd, cflag);
-                cflag = *(++cflags);
-            }
+    if (WIFEXITED(wstatus)) {
+        int exit_status = WEXITSTATUS(wstatus);
+        if (exit_status != 0) {
+            fprintf(stderr, "[ERROR] command (pid %d) exited with exit code %d\n", pid, exit_status);
+            jobs->failed = true;
+            return false;
         }
+    } else if (WIFSIGNALED(wstatus)) {
+        fprintf(stderr, "[ERROR] command process (pid %d) was terminated\n", pid);
+        jobs->failed = true;
+        return false;
+    }
 
-        cmd_push_str(cmd, "-o", target);
+    return true;
+}
 
-        if (srcs != NULL) {
-            const char* src = *srcs;
-            while (src != NULL) {
-                cmd_push_str(cmd, src);
-                src = *(++srcs);
-            }
-        }
+bool jobs_run(Jobs* jobs, Cmd* cmd, bool log_cmd) {
+    if (jobs->max_jobs == 0) jobs->max_jobs = cpu_count();
 
-        return cmd_run_sync(cmd, true);
+    while (!jobs->failed && jobs->count >= jobs->max_jobs) {
+        jobs_wait_one(jobs);
+    }
+
+    if (jobs->failed) {
+        cmd->count = 0;
+        return false;
+    }
+
+    if (jobs->count == jobs->capacity) {
+        jobs->capacity = jobs->capacity == 0? 8 : jobs->capacity * 2;
+        jobs->items = realloc(jobs->items, sizeof(*jobs->items) * jobs->capacity);
+        assert(jobs->items);
+    }
+
+    // The child has its own copy of the cmd, so it can be reused right away
+    jobs->items[jobs->count++] = cmd_run_async(cmd, log_cmd);
+    cmd->count = 0;
+
+    return true;
+}
+
+bool jobs_wait(Jobs* jobs) {
+    while (jobs->count > 0) {
+        jobs_wait_one(jobs);
+    }
+
+    return !jobs->failed;
+}
+
+bool jobs_maybe_build_c(Jobs* jobs, Cmd* cmd, CC cc, const char* target, const char** srcs, const char** cflags) {
+    if (need_rebuild(target, srcs)) {
+        cmd_push_build_c(cmd, cc, target, srcs, cflags);
+        return jobs_run(jobs, cmd, true);
     }
 
     return true;
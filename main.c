@@ -30,27 +30,27 @@ void dump_people(CJ* cj, size_t n, Person people[n]) {
     cj_end_array(cj);
 }
 
-void dump_nodes(CJ* cj, Node* root) {
-    if (root == NULL) cj_null(cj);
-    else {
-        cj_begin_object(cj);
-
-        cj_key(cj, "value");
-        cj_number(cj, root->value);
+const void* node_next(const void* node) {
+    return ((const Node*)node)->next;
+}
 
-        cj_key(cj, "next");
-        dump_nodes(cj, root->next);
+bool node_value(CJ* cj, const void* node) {
+    return cj_number(cj, ((const Node*)node)->value);
+}
 
-        cj_end_object(cj);
-    }
+void dump_nodes(CJ* cj, Node* root) {
+    cj_list_nested(cj, root, "value", "next", node_next, node_value);
 }
 
 Node* random_nodes(size_t n) {
-    if (n == 0) return NULL;
-    Node* node = malloc(sizeof(*node));
-    node->value = n;
-    node->next = random_nodes(n - 1);
-    return node;
+    Node* root = NULL;
+    for (size_t i = 1; i <= n; ++i) {
+        Node* node = malloc(sizeof(*node));
+        node->value = i;
+        node->next = root;
+        root = node;
+    }
+    return root;
 }
 
 int main(void) {
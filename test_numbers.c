@@ -0,0 +1,176 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+#include <float.h>
+
+#define CJ_IMPLEMENTATION
+#include "cj.h"
+
+// Checks the number parsers against strtod and strtoll, and cj_double against strtod.
+// Inputs come from a fixed seed so every failure can be reproduced
+
+static uint64_t state = 0x9E3779B97F4A7C15ull;
+
+uint64_t next_random(void) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1Dull;
+}
+
+double random_double(void) {
+    while (true) {
+        uint64_t bits = next_random();
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        if (isfinite(d)) return d;
+    }
+}
+
+uint64_t bits_of(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+size_t failures = 0;
+
+void check_double(const char* str) {
+    size_t len = strlen(str);
+    char* end;
+    double expected = strtod(str, &end);
+
+    double got = 0;
+    size_t parsed = cj_parse_double(len, str, &got);
+
+    if (isinf(expected)) {
+        // Too large for a double, which cj_parse_double rejects
+        if (parsed == 0) return;
+    } else if (parsed == (size_t)(end - str) && bits_of(got) == bits_of(expected)) {
+        return;
+    }
+
+    if (failures++ < 10) {
+        fprintf(stderr, "[FAIL] %s: parsed %zu as %.17g, strtod gives %.17g\n", str, parsed, got, expected);
+    }
+}
+
+void check_int(const char* str) {
+    size_t len = strlen(str);
+    char* end;
+    errno = 0;
+    long long expected = strtoll(str, &end, 10);
+    bool fits = errno == 0;
+
+    long long got = 0;
+    size_t parsed = cj_parse_int(len, str, &got);
+
+    if (fits? parsed == len && got == expected : parsed == 0) return;
+
+    if (failures++ < 10) {
+        fprintf(stderr, "[FAIL] %s: parsed %zu as %lld, strtoll gives %lld\n", str, parsed, got, expected);
+    }
+}
+
+void check_round_trip(double d) {
+    char out[64];
+    CJ* cj = cj_new_fixed(out, sizeof(out));
+    cj_begin_array(cj);
+    cj_double(cj, d);
+    cj_end_array(cj);
+    size_t size = cj_size(cj);
+    cj_delete(cj);
+
+    // Drop the brackets
+    out[size - 1] = 0;
+    double back = strtod(out + 1, NULL);
+    if (bits_of(back) == bits_of(d)) return;
+
+    if (failures++ < 10) {
+        fprintf(stderr, "[FAIL] cj_double wrote %.17g as %s\n", d, out + 1);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1? strtoull(argv[1], NULL, 10) : 200000;
+    char str[1024];
+
+    // Shortest and long mantissas. Past 19 digits the slow path decides whatever Eisel-Lemire can't
+    for (size_t i = 0; i < n; ++i) {
+        double d = random_double();
+        snprintf(str, sizeof(str), "%.17g", d);
+        check_double(str);
+        snprintf(str, sizeof(str), "%.*e", 19 + (int)(next_random() % 30), d);
+        check_double(str);
+    }
+
+#if LDBL_MANT_DIG >= 64 && LDBL_MAX_EXP > DBL_MAX_EXP
+    // Exactly halfway between two doubles, and one unit in the last digit to each side
+    for (size_t i = 0; i < n / 10; ++i) {
+        uint64_t bits = bits_of(random_double()) & ~(1ull << 63);
+        double d, next;
+        memcpy(&d, &bits, sizeof(d));
+        bits++;
+        memcpy(&next, &bits, sizeof(next));
+        if (isinf(next)) continue;
+
+        long double halfway = ((long double)d + (long double)next) / 2;
+        snprintf(str, sizeof(str), "%.780Le", halfway);
+        check_double(str);
+
+        // Strip the exponent, trailing zeros and put it back with the last digit moved
+        char* exponent = strchr(str, 'e');
+        char saved[16];
+        snprintf(saved, sizeof(saved), "%s", exponent);
+        char* last = exponent - 1;
+        while (*last == '0') last--;
+        if (*last == '.') continue;
+
+        char digit = *last;
+        if (digit < '9') {
+            *last = digit + 1;
+            snprintf(last + 1, sizeof(str) - (last + 1 - str), "%s", saved);
+            check_double(str);
+        }
+        if (digit > '0') {
+            *last = digit - 1;
+            snprintf(last + 1, sizeof(str) - (last + 1 - str), "%s", saved);
+            check_double(str);
+        }
+    }
+#endif
+
+    static const char* edges[] = {
+        "0", "-0", "0.0", "1e-400", "4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324",
+        "2.2250738585072011e-308", "2.2250738585072014e-308", "1.7976931348623157e308", "1.7976931348623158e308",
+        "1.7976931348623159e308", "1e309", "-1e400", "9007199254740993", "0.1", "123456789012345678901234567890",
+    };
+    for (size_t i = 0; i < sizeof(edges)/sizeof(edges[0]); ++i) {
+        check_double(edges[i]);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        int64_t value = (int64_t)next_random() >> (next_random() % 64);
+        snprintf(str, sizeof(str), "%lld", (long long)value);
+        check_int(str);
+    }
+    static const char* int_edges[] = {
+        "0", "-0", "9223372036854775807", "-9223372036854775808", "9223372036854775808",
+        "-9223372036854775809", "18446744073709551616", "99999999999999999999",
+    };
+    for (size_t i = 0; i < sizeof(int_edges)/sizeof(int_edges[0]); ++i) {
+        check_int(int_edges[i]);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        check_round_trip(random_double());
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "[FAIL] %zu number checks failed\n", failures);
+        return 1;
+    }
+
+    printf("[OK] number checks passed\n");
+    return 0;
+}